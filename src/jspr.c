@@ -2,8 +2,16 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __JSPR_THREADS__
+#include <pthread.h>
+#endif
 
 #include "./jspr.h"
+#include "./jspr_dialect.h"
 
 /**
  * utility: display an standardized error message and exits the program
@@ -15,42 +23,73 @@ void _display_error_and_exit(int err_num) {
   exit(EXIT_FAILURE);
 }
 
-int _display_error_and_return(int err_num, char *string, int length) {
-  #ifdef __DEBUG__
-  fprintf(stderr, "JSPR ERROR: %d. Check around ", err_num);
-  int i;
-  for (i = 0; i < length; i++) {
-    putchar(string[i]);
+
+/**
+ * utility: returns the seed mixed into every key hash, picked once per process
+ * so that colliding keys cannot be crafted in advance (strings can come from
+ * untrusted sources, such as MQTT payloads)
+ *
+ * With __JSPR_THREADS__, the seed is picked under pthread_once and any thread
+ * can be the first one to use the library. Without it, the first organism or
+ * key must be created before other threads start using the library.
+ * @return the seed
+ */
+
+static unsigned int _hash_seed = 0;
+#ifdef __JSPR_THREADS__
+static pthread_once_t _hash_seed_once = PTHREAD_ONCE_INIT;
+#else
+static int _hash_seeded = 0;
+#endif
+
+void _hash_pick_seed(void) {
+  // address of the seed changes from one process to another with ASLR
+  unsigned int seed = (unsigned int)time(NULL)
+    ^ (unsigned int)clock()
+    ^ (unsigned int)(uintptr_t)&_hash_seed;
+  // murmur3 finalizer, to spread the few bits that actually change
+  seed ^= seed >> 16;
+  seed *= 0x85ebca6bu;
+  seed ^= seed >> 13;
+  seed *= 0xc2b2ae35u;
+  seed ^= seed >> 16;
+  _hash_seed = seed;
+}
+
+unsigned int _hash_get_seed(void) {
+  #ifdef __JSPR_THREADS__
+  pthread_once(&_hash_seed_once, _hash_pick_seed);
+  #else
+  if (!_hash_seeded) {
+    _hash_pick_seed();
+    _hash_seeded = 1;
   }
-  putchar('\n');
   #endif
-
-  return err_num;
+  return _hash_seed;
 }
 
 /**
- * returns a pointer to the first needle between start and end,
- * or NULL if not found
- * @param  needle the char being researched
- * @param  start  pointer to the beginning of search zone
- * @param  end    pointer to end of search zone
- * @return        pointer to the first needle, or NULL if not found
+ * utility: hashes length bytes starting at start (seeded 32 bits FNV-1a)
+ * @param  start  pointer to the first byte to hash
+ * @param  length number of bytes to hash
+ * @return        the hash
  */
 
-char* _find_first_char_between(char needle, char *start, char *end) {
-  char *pointer = start;
-  while (pointer != end) {
-    if (*pointer == needle)
-      return pointer;
-    pointer++;
+unsigned int _hash_bytes(char *start, int length) {
+  unsigned int hash = 2166136261u ^ _hash_get_seed();
+  int i;
+  for (i = 0; i < length; i++) {
+    hash ^= (unsigned char)start[i];
+    hash *= 16777619u;
   }
-  return NULL;
+  return hash;
 }
 
 /**
  * Data lifecycle methods for
  *   jspr_atom_t
  *   jspr_molecule_t
+ *   jspr_key_t
  *   jspr_organism_t
  * including an initializer, a setter and a destructor for each structure
  *
@@ -97,6 +136,31 @@ void jspr_molecule_destroy(jspr_molecule_t *molecule) {
   jspr_atom_destroy(molecule->value);
   free(molecule);
 }
+
+jspr_key_t* jspr_key_initialize(void) {
+  jspr_key_t *key = malloc(sizeof(jspr_key_t));
+  if (key == NULL)
+    _display_error_and_exit(errno);
+  key->start = NULL;
+  key->length = 0;
+  key->hash = _hash_bytes(NULL, 0);
+  return key;
+}
+
+/**
+ * The key does not need to be NULL terminated, and its hash is computed
+ * once here so that repeated lookups of the same key skip it
+ */
+void jspr_key_set(jspr_key_t *key, char *start, int length) {
+  key->start = start;
+  key->length = length;
+  key->hash = _hash_bytes(start, length);
+}
+
+void jspr_key_destroy(jspr_key_t *key) {
+  free(key);
+}
+
 /**
  * String len provided by user here !!
  */
@@ -112,22 +176,155 @@ jspr_organism_t* jspr_organism_initialize(int size, char *ref_string, int ref_st
   organism->total = 0;
   organism->ref_string = ref_string;
   organism->ref_string_len = ref_string_len;
+  organism->duplicate_policy = DUPLICATE_POLICY_FIRST_WINS;
   organism->molecules = malloc(sizeof(jspr_molecule_t*) * size);
+  organism->next_duplicate = malloc(sizeof(int) * size);
 
-  if (organism->molecules == NULL)
+  if (organism->molecules == NULL || organism->next_duplicate == NULL)
     _display_error_and_exit(errno);
 
   int i;
   for (i = 0; i < size; i++) {
     organism->molecules[i] = NULL;
+    organism->next_duplicate[i] = -1;
+  }
+
+  // key index: open addressing, kept at most half full so probes stay short
+  organism->index_size = 2;
+  while (organism->index_size / 2 < size) {
+    if (organism->index_size > INT_MAX / 2)
+      _display_error_and_exit(EOVERFLOW);
+    organism->index_size <<= 1;
+  }
+  // pick the seed now, before the threads of jspr_organism_populate_parallel need it
+  _hash_get_seed();
+  organism->index = malloc(sizeof(jspr_index_slot_t) * organism->index_size);
+
+  if (organism->index == NULL)
+    _display_error_and_exit(errno);
+
+  for (i = 0; i < organism->index_size; i++) {
+    organism->index[i].first = -1;
+    organism->index[i].last = -1;
   }
   return organism;
 }
 
+/**
+ * Sets the policy applied when a key appears more than once in the string.
+ * Must be called before jspr_organism_populate
+ *
+ *   DUPLICATE_POLICY_FIRST_WINS  (default) lookups see the first occurrence
+ *   DUPLICATE_POLICY_LAST_WINS   lookups see the last occurrence
+ *   DUPLICATE_POLICY_REJECT      population fails with ERR_DUPLICATE_KEY
+ *   DUPLICATE_POLICY_COLLECT_ALL lookups see the first occurrence,
+ *                                jspr_organism_find_all sees all of them
+ */
+void jspr_organism_set_duplicate_policy(jspr_organism_t *organism, jspr_duplicate_policy_t policy) {
+  organism->duplicate_policy = policy;
+}
+
+/**
+ * Finds the index slot for a key, that is either the slot already holding
+ * that key or the empty slot where it should be inserted
+ * @param  organism pointer to the organism
+ * @param  key      pointer to the first char of the key
+ * @param  key_len  length of the key
+ * @param  hash     hash of the key
+ * @return          pointer to the slot
+ */
+jspr_index_slot_t* _jspr_organism_index_slot(jspr_organism_t *organism, char *key, int key_len, unsigned int hash) {
+  unsigned int mask = organism->index_size - 1;
+  unsigned int position = hash & mask;
+  jspr_index_slot_t *slot = &organism->index[position];
+  while (slot->first != -1) {
+    if (slot->hash == hash) {
+      jspr_atom_t *slot_key = organism->molecules[slot->first]->key;
+      if (slot_key->end - slot_key->start == key_len
+          && memcmp(slot_key->start, key, key_len) == 0)
+        return slot;
+    }
+    position = (position + 1) & mask;
+    slot = &organism->index[position];
+  }
+  return slot;
+}
+
+int _jspr_organism_index_hashed_molecule(jspr_organism_t *organism, int position, unsigned int hash);
+
+/**
+ * Registers the key of the molecule at a given position in the index,
+ * enforcing the duplicate key policy
+ * @param  organism pointer to the organism
+ * @param  position position of the molecule in organism->molecules
+ * @return          0 on success, ERR_DUPLICATE_KEY if the key is a rejected duplicate
+ */
+int _jspr_organism_index_molecule(jspr_organism_t *organism, int position) {
+  jspr_molecule_t *molecule = organism->molecules[position];
+  if (molecule->key == NULL)
+    return 0;
+  return _jspr_organism_index_hashed_molecule(
+    organism,
+    position,
+    _hash_bytes(molecule->key->start, molecule->key->end - molecule->key->start)
+  );
+}
+
+/**
+ * Same as _jspr_organism_index_molecule, for a molecule whose key hash is
+ * already known (the molecule must have a key)
+ * @param  organism pointer to the organism
+ * @param  position position of the molecule in organism->molecules
+ * @param  hash     hash of the key of the molecule
+ * @return          0 on success, ERR_DUPLICATE_KEY if the key is a rejected duplicate
+ */
+int _jspr_organism_index_hashed_molecule(jspr_organism_t *organism, int position, unsigned int hash) {
+  char *key = organism->molecules[position]->key->start;
+  int key_len = organism->molecules[position]->key->end - key;
+  jspr_index_slot_t *slot = _jspr_organism_index_slot(organism, key, key_len, hash);
+
+  if (slot->first == -1) {
+    slot->hash = hash;
+    slot->first = position;
+    slot->last = position;
+    return 0;
+  }
+  switch (organism->duplicate_policy) {
+    case DUPLICATE_POLICY_REJECT:
+      return _display_error_and_return(ERR_DUPLICATE_KEY, key, key_len);
+    case DUPLICATE_POLICY_LAST_WINS:
+      slot->first = position;
+      slot->last = position;
+      break;
+    case DUPLICATE_POLICY_COLLECT_ALL:
+      organism->next_duplicate[slot->last] = position;
+      slot->last = position;
+      break;
+    case DUPLICATE_POLICY_FIRST_WINS:
+    default:
+      break;
+  }
+  return 0;
+}
+
+/**
+ * Adds a molecule to the organism and registers its key in the index
+ * @param  organism pointer to the organism
+ * @param  molecule pointer to the molecule
+ * @return          0 on success, -1 if the organism is full,
+ *                  ERR_DUPLICATE_KEY if the key is a rejected duplicate
+ *                  (the molecule is not added in that case)
+ */
 int jspr_organism_add_molecule(jspr_organism_t* organism, jspr_molecule_t *molecule) {
+  int r;
   if (organism->size == organism->total)
     return -1;
-  organism->molecules[organism->total++] = molecule;
+  organism->molecules[organism->total] = molecule;
+  if ((r = _jspr_organism_index_molecule(organism, organism->total)) != 0) {
+    organism->molecules[organism->total] = NULL;
+    return r;
+  }
+  organism->total++;
   return 0;
 }
 
@@ -138,6 +335,8 @@ void jspr_organism_destroy(jspr_organism_t *organism) {
     jspr_molecule_destroy(organism->molecules[i]);
   }
   free(organism->molecules);
+  free(organism->next_duplicate);
+  free(organism->index);
   free(organism);
 }
 
@@ -189,151 +388,269 @@ void _jspr_organism_print(jspr_organism_t *organism) {
  * @param  string_len length of string to test
  * @return            number of molecules in string, or -1 if invalid
  */
+
 int jspr_size(char *string, int string_len) {
-  int atom_sep_counter = 0;
-  int molecule_sep_counter = 0;
-  char *c = string;
-  int i;
-  for (i = 0; i < string_len; i++) {
-    if (*c == MOLECULE_SPLIT_KEY)
-      molecule_sep_counter++;
-    if (*c == ATOM_SPLIT_KEY)
-      atom_sep_counter++;
-    c++;
-  }
-  // check if we have a valid JSON shape
-  if (atom_sep_counter != molecule_sep_counter + 1)
-    return -1;
-  // return number of molecules (sep + 1)
-  return molecule_sep_counter + 1;
+  return _jspr_size_generic(string, string_len, MOLECULE_SPLIT_KEY, ATOM_SPLIT_KEY);
 }
 
+
+
 /**
- * populates the atom structure, performing a few structural checks along the way
- * TODO: should perhaps move the test somewhere else?
- * what is expected here are two pointers delimiting a string of shape
- * "some stuff" OR some_stuff (first case are string value, other is number)
- * ie: "some stuff"        OR 123456789
- *     ^start      ^end       ^start   ^end
- *
- * @param  atom  pointer to the atom structure
- * @param  start
- * @param  end
- * @return       error code
+ * populates the atom structure
+ * (see _jspr_atom_populate_generic in jspr_dialect.h)
  */
 int jspr_atom_populate(jspr_atom_t *atom, char* start, char* end) {
-  char is_string_key = '\"';
-  int length = end - start;
-  char *atom_start;
-  char *atom_end;
-  jspr_atom_type_t atom_type;
-  if (*start == is_string_key) {
-    // we have a string token
-    atom_type = ATOM_TYPE_STRING;
-    atom_start = start + 1;
-    if (*(start + length - 1) != is_string_key)
-      return _display_error_and_return(ERR_INVAL, start, length);
-    atom_end = start + length - 1;
-  } else {
-    // we have a number token
-    atom_type = ATOM_TYPE_PRIMITIVE;
-    atom_start = start;
-    if (*(start + length - 1) == is_string_key)
-      return _display_error_and_return(ERR_INVAL, start, length);
-    atom_end = end;
-  }
-  jspr_atom_set(atom, atom_start, atom_end, atom_type);
-  return RETURN_SUCCESS;
+  return _jspr_atom_populate_generic(atom, start, end);
 }
 
 /**
- * Populates the molecule structure
- * what is expected here pointers delimiting string of shape
- * "key":value        OR "key":"string_value"
- * ^start     ^end       ^start              ^end
+ * Populates the molecule structure of a JSON string
+ * (see _jspr_molecule_populate_generic in jspr_dialect.h)
+ */
+int jspr_molecule_populate(jspr_molecule_t *molecule, char* start, char* end) {
+  return _jspr_molecule_populate_generic(molecule, start, end, ATOM_SPLIT_KEY, 1);
+}
+
+
+/**
+ * Populates the organism structure by parsing the JSON string ref_string
  *
- * @param  molecule pointer to the molecule structure
- * @param  start
- * @param  end
+ * @param  organism pointer to the organism structure
  * @return          error code
  */
+int jspr_organism_populate(jspr_organism_t *organism) {
+  return _jspr_organism_populate_generic(organism, MOLECULE_SPLIT_KEY, ATOM_SPLIT_KEY, 1, 1);
+}
 
-int jspr_molecule_populate(jspr_molecule_t *molecule, char* start, char* end) {
-  char *split_pointer = _find_first_char_between(ATOM_SPLIT_KEY, start, end);
-  int r;
-  if (split_pointer == NULL)
-    return _display_error_and_return(ERR_INVAL, start, end - start);
-  jspr_atom_t *key = jspr_atom_initialize();
-  if ((r = jspr_atom_populate(key, start, split_pointer)) != RETURN_SUCCESS) {
-    jspr_atom_destroy(key);
-    return r;
-  }
-  // test that the key is an atom of type string (strict JSON)
-  if (key->type != ATOM_TYPE_STRING) {
-    // free malloced memory (avoid leaks)
-    jspr_atom_destroy(key);
-    return _display_error_and_return(ERR_STRICT_JSON, start, end - split_pointer);
+/**
+ * Resumable parsing: a parser populates an organism a few bytes at a time,
+ * so that a big string can be parsed without blocking an event loop.
+ *
+ *   jspr_parser_t *parser = jspr_parser_initialize(organism);
+ *   while ((r = jspr_parser_step(parser, 65536)) == RETURN_MORE_WORK) {
+ *     // yield, then come back for more
+ *   }
+ *   // r is RETURN_SUCCESS, or an error code
+ *
+ * The organism (and its ref_string) must stay alive until parsing is over,
+ * and the parser does not own it.
+ */
+
+jspr_parser_t* jspr_parser_initialize(jspr_organism_t *organism) {
+  jspr_parser_t *parser = malloc(sizeof(jspr_parser_t));
+  if (parser == NULL)
+    _display_error_and_exit(errno);
+  parser->organism = organism;
+  // set by the first step, as they depend on the dialect
+  parser->molecule_start = NULL;
+  parser->scan = NULL;
+  parser->content_end = NULL;
+  parser->status = RETURN_MORE_WORK;
+  return parser;
+}
+
+void jspr_parser_destroy(jspr_parser_t *parser) {
+  free(parser);
+}
+
+
+int jspr_parser_step(jspr_parser_t *parser, int max_bytes) {
+  return _jspr_parser_step_generic(parser, max_bytes, MOLECULE_SPLIT_KEY, ATOM_SPLIT_KEY, 1, 1);
+}
+
+// built-in dialects (see JSPR_DIALECTS in jspr.h)
+JSPR_DIALECTS(JSPR_DIALECT_DEFINE)
+
+#ifdef __JSPR_THREADS__
+/**
+ * Work unit of jspr_organism_populate_parallel: a chunk of the content of
+ * ref_string, that is ref_string without its enclosing { and } (the range
+ * jspr_organism_populate searches for separators in).
+ * A chunk owns every molecule whose opening separator (the { for the first chunk,
+ * a MOLECULE_SPLIT_KEY otherwise) lies inside it, even if that molecule ends in a
+ * later chunk, so that chunks can be cut anywhere without fixing up boundaries.
+ * Key hashes are computed by the chunk too, while keys are still in cache,
+ * leaving only the insertion in the index to be done sequentially
+ */
+typedef struct _jspr_chunk {
+  jspr_organism_t *organism;
+  unsigned int *hashes;
+  char *start;
+  char *end;
+  int separators;
+  int first_position;
+  int error;
+  int error_position;
+} _jspr_chunk_t;
+
+void* _jspr_chunk_count(void *arg) {
+  _jspr_chunk_t *chunk = arg;
+  char *c;
+  chunk->separators = 0;
+  for (c = chunk->start; c != chunk->end; c++) {
+    if (*c == MOLECULE_SPLIT_KEY)
+      chunk->separators++;
   }
+  return NULL;
+}
 
-  jspr_atom_t *value = jspr_atom_initialize();
-  if((r = jspr_atom_populate(value, split_pointer + 1, end)) != RETURN_SUCCESS) {
-    jspr_atom_destroy(value);
-    jspr_atom_destroy(key);
-    return r;
+void* _jspr_chunk_populate(void *arg) {
+  _jspr_chunk_t *chunk = arg;
+  jspr_organism_t *organism = chunk->organism;
+  char *content_start = organism->ref_string + 1;
+  char *content_end = organism->ref_string + organism->ref_string_len - 1;
+  int position = chunk->first_position;
+  char *molecule_start = content_start;
+  char *needle;
+  int r;
+
+  chunk->error = RETURN_SUCCESS;
+  // only the first chunk starts right after the opening {
+  if (chunk->start != content_start) {
+    needle = _find_first_char_between(MOLECULE_SPLIT_KEY, chunk->start, chunk->end);
+    if (needle == NULL)
+      return NULL;
+    molecule_start = needle + 1;
   }
 
-  jspr_molecule_set(molecule, key, value);
-  return RETURN_SUCCESS;
+  while (1) {
+    needle = _find_first_char_between(MOLECULE_SPLIT_KEY, molecule_start, content_end);
+    jspr_molecule_t *molecule = jspr_molecule_initialize();
+    r = jspr_molecule_populate(
+      molecule,
+      molecule_start,
+      needle == NULL ? content_end : needle
+    );
+    if (r != RETURN_SUCCESS) {
+      jspr_molecule_destroy(molecule);
+      chunk->error = r;
+      chunk->error_position = position;
+      return NULL;
+    }
+    // as in jspr_organism_populate, molecules past the size are checked, but not kept
+    if (position < organism->size) {
+      organism->molecules[position] = molecule;
+      chunk->hashes[position] = _hash_bytes(
+        molecule->key->start,
+        molecule->key->end - molecule->key->start
+      );
+    } else {
+      jspr_molecule_destroy(molecule);
+    }
+    position++;
+    // the molecule after needle belongs to the chunk holding needle
+    if (needle == NULL || needle >= chunk->end)
+      return NULL;
+    molecule_start = needle + 1;
+  }
 }
+#endif
 
 /**
- * Populates the organism structure by parsing the JSON string ref_string
+ * Same as jspr_organism_populate, but splits ref_string in chunks that are
+ * parsed by several threads. The key index is then filled in string order,
+ * so the return code, total and molecules kept (after an error, a rejected
+ * duplicate or past the size of the organism) are the same as with
+ * jspr_organism_populate.
+ *
+ * Only available when compiled with __JSPR_THREADS__ (make THREADS=1),
+ * otherwise falls back to jspr_organism_populate. JSON only: dialects have no
+ * parallel version.
  *
  * @param  organism pointer to the organism structure
+ * @param  threads  number of threads to use
  * @return          error code
  */
-int jspr_organism_populate(jspr_organism_t *organism) {
-  // skip the first {
-  char *ref_string_start = organism->ref_string;
-  char *ref_string_end = organism->ref_string + organism->ref_string_len;
-  // should be {some stuff that looks like jspr}
-  //           ^start                           ^end
-  char *pointer = ref_string_start;
-  char *needle = _find_first_char_between(
-    MOLECULE_SPLIT_KEY,
-    pointer,
-    ref_string_end
-  );
-  int counter = 0;
-  int r;
-  while (needle != NULL) {
-    jspr_molecule_t *molecule = jspr_molecule_initialize();
-    if ((r = jspr_molecule_populate(molecule, pointer + 1, needle)) != RETURN_SUCCESS) {
-      jspr_molecule_destroy(molecule);
-      return r;
+int jspr_organism_populate_parallel(jspr_organism_t *organism, int threads) {
+  #ifdef __JSPR_THREADS__
+  // chunks split the content, between the enclosing { and }
+  int content_len = organism->ref_string_len - 2;
+  if (threads > content_len)
+    threads = content_len;
+  if (threads <= 1)
+    return jspr_organism_populate(organism);
+
+  _jspr_chunk_t *chunks = malloc(sizeof(_jspr_chunk_t) * threads);
+  pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+  unsigned int *hashes = malloc(sizeof(unsigned int) * (organism->size > 0 ? organism->size : 1));
+  if (chunks == NULL || workers == NULL || hashes == NULL)
+    _display_error_and_exit(errno);
+
+  int chunk_len = content_len / threads;
+  int i, r;
+  for (i = 0; i < threads; i++) {
+    chunks[i].organism = organism;
+    chunks[i].hashes = hashes;
+    chunks[i].start = organism->ref_string + 1 + i * chunk_len;
+    chunks[i].end = (i == threads - 1)
+      ? organism->ref_string + 1 + content_len
+      : chunks[i].start + chunk_len;
+  }
+
+  // first pass: count separators per chunk to know where each chunk writes
+  for (i = 0; i < threads; i++) {
+    if ((r = pthread_create(&workers[i], NULL, _jspr_chunk_count, &chunks[i])) != 0)
+      _display_error_and_exit(r);
+  }
+  for (i = 0; i < threads; i++)
+    pthread_join(workers[i], NULL);
+
+  int separators = 0;
+  for (i = 0; i < threads; i++) {
+    // molecule following the n-th separator is at position n + 1 (0 is after the {)
+    chunks[i].first_position = (i == 0) ? 0 : separators + 1;
+    separators += chunks[i].separators;
+  }
+
+  // second pass: populate molecules directly at their final position
+  for (i = 0; i < threads; i++) {
+    if ((r = pthread_create(&workers[i], NULL, _jspr_chunk_populate, &chunks[i])) != 0)
+      _display_error_and_exit(r);
+  }
+  for (i = 0; i < threads; i++)
+    pthread_join(workers[i], NULL);
+
+  // the first chunk in error holds the first parsing error of the string
+  int error = RETURN_SUCCESS;
+  int total = separators + 1 < organism->size ? separators + 1 : organism->size;
+  for (i = 0; i < threads; i++) {
+    if (chunks[i].error != RETURN_SUCCESS) {
+      error = chunks[i].error;
+      if (chunks[i].error_position < total)
+        total = chunks[i].error_position;
+      break;
     }
-    jspr_organism_add_molecule(organism, molecule);
-    pointer = needle++;
-    counter++;
-    needle = _find_first_char_between(
-      MOLECULE_SPLIT_KEY,
-      needle,
-      ref_string_end
-    );
   }
-  // still need to process the last one
-  jspr_molecule_t *molecule = jspr_molecule_initialize();
-  if ((r = jspr_molecule_populate(molecule, pointer + 1, ref_string_end - 1)) != RETURN_SUCCESS) {
-    jspr_molecule_destroy(molecule);
-    return r;
+
+  // register keys in string order, stopping where jspr_organism_populate would
+  r = RETURN_SUCCESS;
+  for (i = 0; i < total; i++) {
+    if ((r = _jspr_organism_index_hashed_molecule(organism, i, hashes[i])) != 0)
+      break;
+  }
+  organism->total = i;
+  // like jspr_organism_populate, keep nothing past the last registered molecule
+  for (; i < organism->size; i++) {
+    jspr_molecule_destroy(organism->molecules[i]);
+    organism->molecules[i] = NULL;
   }
-  jspr_organism_add_molecule(organism, molecule);
+  free(chunks);
+  free(workers);
+  free(hashes);
+  if (r != RETURN_SUCCESS)
+    return r;
+  if (error != RETURN_SUCCESS)
+    return error;
 
   #ifdef __DEBUG__
-  printf("Finish populating organism of size %d, added %d molecules.\n", organism->size, counter + 1);
+  printf("Finish populating organism of size %d with %d threads, added %d molecules.\n", organism->size, threads, total);
   #endif
 
   return 0;
+  #else
+  (void)threads;
+  return jspr_organism_populate(organism);
+  #endif
 }
 
 /**
@@ -344,16 +661,43 @@ int jspr_organism_populate(jspr_organism_t *organism) {
  * @return          1 if match, 0 if not
  */
 int jspr_molecule_matches_string(jspr_molecule_t *molecule, char* string) {
-  int counter = 0;
   int key_len = molecule->key->end - molecule->key->start;
-  char *pointer = string;
-  while (*pointer && counter <= key_len) {
-    if (*pointer++ != molecule->key->start[counter])
-      return 0;
-    counter ++;
-  }
-  if (counter != key_len)
+  int string_len = strlen(string);
+  if (string_len != key_len)
     return 0;
+  return memcmp(molecule->key->start, string, key_len) == 0;
+}
+
+/**
+ * Looks a key up in the organism index
+ * @param  organism pointer to the organism
+ * @param  key      key to search for
+ * @return          pointer to the index slot of that key, or NULL if not found
+ */
+jspr_index_slot_t* _jspr_organism_lookup(jspr_organism_t *organism, jspr_key_t *key) {
+  jspr_index_slot_t *slot = _jspr_organism_index_slot(
+    organism,
+    key->start,
+    key->length,
+    key->hash
+  );
+  if (slot->first == -1)
+    return NULL;
+  return slot;
+}
+
+/**
+ * Fills an atom structure with the value held by the molecule of an index slot
+ * @param  atom     pointer to an atom structure
+ * @param  organism pointer to an organism structure
+ * @param  slot     index slot of the key, may be NULL
+ * @return          1 if found, 0 if not
+ */
+int _jspr_organism_find_slot(jspr_atom_t *atom, jspr_organism_t *organism, jspr_index_slot_t *slot) {
+  if (slot == NULL)
+    return 0;
+  jspr_atom_t *value = organism->molecules[slot->first]->value;
+  jspr_atom_set(atom, value->start, value->end, value->type);
   return 1;
 }
 
@@ -364,34 +708,112 @@ int jspr_molecule_matches_string(jspr_molecule_t *molecule, char* string) {
  * @return          1 if found, 0 if not
  */
 int jspr_organism_contains_key(jspr_organism_t *organism, char *key) {
-  int i;
-  for (i = 0; i < organism ->size; i++) {
-    if (jspr_molecule_matches_string(organism->molecules[i], key))
-      return 1;
-  }
-  return 0;
+  return jspr_organism_contains_key_n(organism, key, strlen(key));
+}
+
+/**
+ * Same as jspr_organism_contains_key, for a key that is not NULL terminated
+ * @param  organism pointer to the organism
+ * @param  key      key to search for
+ * @param  key_len  length of the key
+ * @return          1 if found, 0 if not
+ */
+int jspr_organism_contains_key_n(jspr_organism_t *organism, char *key, int key_len) {
+  jspr_key_t lookup_key;
+  jspr_key_set(&lookup_key, key, key_len);
+  return _jspr_organism_lookup(organism, &lookup_key) != NULL;
 }
 
 /**
  * Tests if an organism contains a specific key,
  * and fills an atom structure with the value associated to that key (if found)
+ * Which value is returned for duplicate keys depends on the duplicate policy
  * @param  atom     pointer to an atom structure
  * @param  organism pointer to an organism structure
  * @param  key      key to search for
  * @return          1 if found, 0 if not
  */
 int jspr_organism_find(jspr_atom_t *atom, jspr_organism_t *organism, char *key) {
-  int i;
-  for (i = 0; i < organism->size; i++) {
-    if (jspr_molecule_matches_string(organism->molecules[i], key)) {
-      jspr_atom_set(
-        atom,
-        organism->molecules[i]->value->start,
-        organism->molecules[i]->value->end,
-        organism->molecules[i]->value->type
-      );
-      return 1;
+  return jspr_organism_find_n(atom, organism, key, strlen(key));
+}
+
+/**
+ * Same as jspr_organism_find, for a key that is not NULL terminated
+ * (for instance, pointing inside another buffer)
+ * @param  atom     pointer to an atom structure
+ * @param  organism pointer to an organism structure
+ * @param  key      key to search for
+ * @param  key_len  length of the key
+ * @return          1 if found, 0 if not
+ */
+int jspr_organism_find_n(jspr_atom_t *atom, jspr_organism_t *organism, char *key, int key_len) {
+  jspr_key_t lookup_key;
+  jspr_key_set(&lookup_key, key, key_len);
+  return _jspr_organism_find_slot(atom, organism, _jspr_organism_lookup(organism, &lookup_key));
+}
+
+/**
+ * Same as jspr_organism_find, for a key whose length and hash have already
+ * been computed by jspr_key_set (useful when the same key is looked up often)
+ * @param  atom     pointer to an atom structure
+ * @param  organism pointer to an organism structure
+ * @param  key      pointer to the key structure
+ * @return          1 if found, 0 if not
+ */
+int jspr_organism_find_key(jspr_atom_t *atom, jspr_organism_t *organism, jspr_key_t *key) {
+  return _jspr_organism_find_slot(atom, organism, _jspr_organism_lookup(organism, key));
+}
+
+/**
+ * Fills an array of atom structures with every value associated to a key,
+ * in the order they appear in the string.
+ * Unless the duplicate policy is DUPLICATE_POLICY_COLLECT_ALL, there is at most one
+ * @param  atoms     array of pointers to atom structures
+ * @param  atoms_len number of atoms in the array
+ * @param  organism  pointer to an organism structure
+ * @param  key       key to search for
+ * @return           number of values found (atoms past atoms_len are not filled)
+ */
+int jspr_organism_find_all(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, char *key) {
+  return jspr_organism_find_all_n(atoms, atoms_len, organism, key, strlen(key));
+}
+
+/**
+ * Same as jspr_organism_find_all, for a key that is not NULL terminated
+ * @param  atoms     array of pointers to atom structures
+ * @param  atoms_len number of atoms in the array
+ * @param  organism  pointer to an organism structure
+ * @param  key       key to search for
+ * @param  key_len   length of the key
+ * @return           number of values found (atoms past atoms_len are not filled)
+ */
+int jspr_organism_find_all_n(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, char *key, int key_len) {
+  jspr_key_t lookup_key;
+  jspr_key_set(&lookup_key, key, key_len);
+  return jspr_organism_find_all_key(atoms, atoms_len, organism, &lookup_key);
+}
+
+/**
+ * Same as jspr_organism_find_all, for a key prepared by jspr_key_set
+ * @param  atoms     array of pointers to atom structures
+ * @param  atoms_len number of atoms in the array
+ * @param  organism  pointer to an organism structure
+ * @param  key       pointer to the key structure
+ * @return           number of values found (atoms past atoms_len are not filled)
+ */
+int jspr_organism_find_all_key(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, jspr_key_t *key) {
+  jspr_index_slot_t *slot = _jspr_organism_lookup(organism, key);
+  if (slot == NULL)
+    return 0;
+  int counter = 0;
+  int position = slot->first;
+  while (position != -1) {
+    if (counter < atoms_len) {
+      jspr_atom_t *value = organism->molecules[position]->value;
+      jspr_atom_set(atoms[counter], value->start, value->end, value->type);
     }
+    counter++;
+    position = organism->next_duplicate[position];
   }
-  return 0;
+  return counter;
 }
@@ -4,9 +4,22 @@
 #define MOLECULE_SPLIT_KEY ','
 #define ATOM_SPLIT_KEY ':'
 
+/**
+ * Parser dialects other than JSON built in the library, each one generating its own specialized
+ *   int jspr_<name>_size(char *string, int string_len);
+ *   int jspr_<name>_organism_populate(jspr_organism_t *organism);
+ *   int jspr_<name>_parser_step(jspr_parser_t *parser, int max_bytes);
+ * Entries are X(name, molecule split key, atom split key, keys must be strings, enclosed in {})
+ * Other dialects can be added outside of the library, see jspr_dialect.h
+ */
+#define JSPR_DIALECTS(X) \
+  X(kv, ';', '=', 0, 0)
+
 #define RETURN_SUCCESS 0
+#define RETURN_MORE_WORK 1
 #define ERR_INVAL -1
 #define ERR_STRICT_JSON -2
+#define ERR_DUPLICATE_KEY -3
 
 typedef enum {
   ATOM_TYPE_UNDEFINED = 0,
@@ -14,6 +27,13 @@ typedef enum {
   ATOM_TYPE_STRING = 2
 } jspr_atom_type_t;
 
+typedef enum {
+  DUPLICATE_POLICY_FIRST_WINS = 0,
+  DUPLICATE_POLICY_LAST_WINS = 1,
+  DUPLICATE_POLICY_REJECT = 2,
+  DUPLICATE_POLICY_COLLECT_ALL = 3
+} jspr_duplicate_policy_t;
+
 typedef struct jspr_atom {
   char *start;
   char *end;
@@ -25,14 +45,38 @@ typedef struct jspr_molecule {
   jspr_atom_t *value;
 } jspr_molecule_t;
 
+typedef struct jspr_key {
+  char *start;
+  int length;
+  unsigned int hash;
+} jspr_key_t;
+
+typedef struct jspr_index_slot {
+  unsigned int hash;
+  int first;
+  int last;
+} jspr_index_slot_t;
+
 typedef struct jspr_organism {
   jspr_molecule_t **molecules;
   int size;
   int total;
   char *ref_string;
   int ref_string_len;
+  jspr_duplicate_policy_t duplicate_policy;
+  jspr_index_slot_t *index;
+  int index_size;
+  int *next_duplicate;
 } jspr_organism_t;
 
+typedef struct jspr_parser {
+  jspr_organism_t *organism;
+  char *molecule_start;
+  char *scan;
+  char *content_end;
+  int status;
+} jspr_parser_t;
+
 jspr_atom_t* jspr_atom_initialize(void);
 void jspr_atom_set(jspr_atom_t *atom, char* start, char *end, jspr_atom_type_t type);
 void jspr_atom_destroy(jspr_atom_t *atom);
@@ -41,14 +85,37 @@ jspr_molecule_t* jspr_molecule_initialize(void);
 void jspr_molecule_set(jspr_molecule_t *molecule, jspr_atom_t *key, jspr_atom_t *value);
 void jspr_molecule_destroy(jspr_molecule_t *molecule);
 
+jspr_key_t* jspr_key_initialize(void);
+void jspr_key_set(jspr_key_t *key, char *start, int length);
+void jspr_key_destroy(jspr_key_t *key);
+
 jspr_organism_t* jspr_organism_initialize(int size, char* ref_string, int ref_string_len);
 int jspr_organism_add_molecule(jspr_organism_t *organism, jspr_molecule_t *molecule);
+void jspr_organism_set_duplicate_policy(jspr_organism_t *organism, jspr_duplicate_policy_t policy);
 void jspr_organism_destroy(jspr_organism_t *organism);
 
 int jspr_organism_populate(jspr_organism_t *organism);
+int jspr_organism_populate_parallel(jspr_organism_t *organism, int threads);
+
+jspr_parser_t* jspr_parser_initialize(jspr_organism_t *organism);
+int jspr_parser_step(jspr_parser_t *parser, int max_bytes);
+void jspr_parser_destroy(jspr_parser_t *parser);
+
+#define JSPR_DIALECT_DECLARE(name, molecule_split, atom_split, strict, enclosed) \
+  int jspr_##name##_size(char *string, int string_len); \
+  int jspr_##name##_organism_populate(jspr_organism_t *organism); \
+  int jspr_##name##_parser_step(jspr_parser_t *parser, int max_bytes);
+
+JSPR_DIALECTS(JSPR_DIALECT_DECLARE)
 
 int jspr_size(char* string, int string_len);
 int jspr_organism_contains_key(jspr_organism_t *organism, char *key);
+int jspr_organism_contains_key_n(jspr_organism_t *organism, char *key, int key_len);
 int jspr_organism_find(jspr_atom_t *atom, jspr_organism_t *organism, char *key);
+int jspr_organism_find_n(jspr_atom_t *atom, jspr_organism_t *organism, char *key, int key_len);
+int jspr_organism_find_key(jspr_atom_t *atom, jspr_organism_t *organism, jspr_key_t *key);
+int jspr_organism_find_all(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, char *key);
+int jspr_organism_find_all_n(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, char *key, int key_len);
+int jspr_organism_find_all_key(jspr_atom_t **atoms, int atoms_len, jspr_organism_t *organism, jspr_key_t *key);
 
 #endif
@@ -0,0 +1,310 @@
+#ifndef __JSPR_DIALECT_H__
+#define __JSPR_DIALECT_H__
+
+/**
+ * Generic parsing functions, used to generate the parser of a dialect.
+ * To add a dialect without modifying the library, declare it where it is used:
+ *   JSPR_DIALECT_DECLARE(semicolon, ';', '=', 0, 0)
+ * and define it in exactly one source file:
+ *   #include "jspr_dialect.h"
+ *   JSPR_DIALECT_DEFINE(semicolon, ';', '=', 0, 0)
+ */
+
+#include <stdio.h>
+
+#include "./jspr.h"
+
+/**
+ * generic parsing functions, down to the byte scan, are forced inline in each
+ * dialect, so that delimiters become constants and every dialect gets its own
+ * specialized loop (nothing below is called through the library)
+ */
+#if defined(__GNUC__)
+#define _JSPR_SPECIALIZE static inline __attribute__((always_inline))
+#else
+#define _JSPR_SPECIALIZE static inline
+#endif
+
+/**
+ * utility: display an error message when built with __DEBUG__, and return the error
+ * @param  err_num error code
+ * @param  string  pointer to the part of the string that caused the error
+ * @param  length  length of that part
+ * @return         err_num
+ */
+static inline int _display_error_and_return(int err_num, char *string, int length) {
+  #ifdef __DEBUG__
+  fprintf(stderr, "JSPR ERROR: %d. Check around ", err_num);
+  int i;
+  for (i = 0; i < length; i++) {
+    putchar(string[i]);
+  }
+  putchar('\n');
+  #else
+  (void)string;
+  (void)length;
+  #endif
+
+  return err_num;
+}
+
+/**
+ * returns a pointer to the first needle between start and end,
+ * or NULL if not found
+ * @param  needle the char being researched
+ * @param  start  pointer to the beginning of search zone
+ * @param  end    pointer to end of search zone
+ * @return        pointer to the first needle, or NULL if not found
+ */
+
+_JSPR_SPECIALIZE char* _find_first_char_between(char needle, char *start, char *end) {
+  char *pointer = start;
+  while (pointer != end) {
+    if (*pointer == needle)
+      return pointer;
+    pointer++;
+  }
+  return NULL;
+}
+
+/**
+ * populates the atom structure, performing a few structural checks along the way
+ * TODO: should perhaps move the test somewhere else?
+ * what is expected here are two pointers delimiting a string of shape
+ * "some stuff" OR some_stuff (first case are string value, other is number)
+ * ie: "some stuff"        OR 123456789
+ *     ^start      ^end       ^start   ^end
+ *
+ * @param  atom  pointer to the atom structure
+ * @param  start
+ * @param  end
+ * @return       error code
+ */
+_JSPR_SPECIALIZE int _jspr_atom_populate_generic(jspr_atom_t *atom, char* start, char* end) {
+  char is_string_key = '\"';
+  int length = end - start;
+  char *atom_start;
+  char *atom_end;
+  jspr_atom_type_t atom_type;
+  if (*start == is_string_key) {
+    // we have a string token
+    atom_type = ATOM_TYPE_STRING;
+    atom_start = start + 1;
+    if (*(start + length - 1) != is_string_key)
+      return _display_error_and_return(ERR_INVAL, start, length);
+    atom_end = start + length - 1;
+  } else {
+    // we have a number token
+    atom_type = ATOM_TYPE_PRIMITIVE;
+    atom_start = start;
+    if (*(start + length - 1) == is_string_key)
+      return _display_error_and_return(ERR_INVAL, start, length);
+    atom_end = end;
+  }
+  jspr_atom_set(atom, atom_start, atom_end, atom_type);
+  return RETURN_SUCCESS;
+}
+
+/**
+ * Counts both separators, see jspr_size
+ */
+_JSPR_SPECIALIZE int _jspr_size_generic(char *string, int string_len, char molecule_split, char atom_split) {
+  int atom_sep_counter = 0;
+  int molecule_sep_counter = 0;
+  char *c = string;
+  int i;
+  for (i = 0; i < string_len; i++) {
+    // no branches: the comparison results are added directly
+    molecule_sep_counter += (*c == molecule_split);
+    atom_sep_counter += (*c == atom_split);
+    c++;
+  }
+  // check if we have a valid JSON shape
+  if (atom_sep_counter != molecule_sep_counter + 1)
+    return -1;
+  // return number of molecules (sep + 1)
+  return molecule_sep_counter + 1;
+}
+
+/**
+ * Populates the molecule structure
+ * what is expected here pointers delimiting string of shape
+ * "key":value        OR "key":"string_value"
+ * ^start     ^end       ^start              ^end
+ *
+ * @param  molecule pointer to the molecule structure
+ * @param  start
+ * @param  end
+ * @return          error code
+ */
+
+_JSPR_SPECIALIZE int _jspr_molecule_populate_generic(jspr_molecule_t *molecule, char* start, char* end, char atom_split, int strict) {
+  char *split_pointer = _find_first_char_between(atom_split, start, end);
+  int r;
+  if (split_pointer == NULL)
+    return _display_error_and_return(ERR_INVAL, start, end - start);
+  jspr_atom_t *key = jspr_atom_initialize();
+  if ((r = _jspr_atom_populate_generic(key, start, split_pointer)) != RETURN_SUCCESS) {
+    jspr_atom_destroy(key);
+    return r;
+  }
+  // test that the key is an atom of type string (strict JSON)
+  if (strict && key->type != ATOM_TYPE_STRING) {
+    // free malloced memory (avoid leaks)
+    jspr_atom_destroy(key);
+    return _display_error_and_return(ERR_STRICT_JSON, start, end - split_pointer);
+  }
+
+  jspr_atom_t *value = jspr_atom_initialize();
+  if((r = _jspr_atom_populate_generic(value, split_pointer + 1, end)) != RETURN_SUCCESS) {
+    jspr_atom_destroy(value);
+    jspr_atom_destroy(key);
+    return r;
+  }
+
+  jspr_molecule_set(molecule, key, value);
+  return RETURN_SUCCESS;
+}
+
+/**
+ * Populates the organism structure by parsing the string ref_string
+ * All parameters but organism are meant to be compile time constants, so that
+ * each dialect gets its own specialized loop once this is inlined
+ *
+ * @param  organism       pointer to the organism structure
+ * @param  molecule_split char separating molecules
+ * @param  atom_split     char separating the key from the value
+ * @param  strict         if set, keys have to be strings
+ * @param  enclosed       if set, the first and last chars ({ and }) are skipped
+ * @return                error code
+ */
+_JSPR_SPECIALIZE int _jspr_organism_populate_generic(jspr_organism_t *organism, char molecule_split, char atom_split, int strict, int enclosed) {
+  // should be {some stuff that looks like jspr}
+  //            ^start                         ^end
+  char *molecule_start = organism->ref_string + enclosed;
+  char *content_end = organism->ref_string + organism->ref_string_len - enclosed;
+  char *needle = _find_first_char_between(
+    molecule_split,
+    molecule_start,
+    content_end
+  );
+  int counter = 0;
+  int r;
+  while (needle != NULL) {
+    jspr_molecule_t *molecule = jspr_molecule_initialize();
+    if ((r = _jspr_molecule_populate_generic(molecule, molecule_start, needle, atom_split, strict)) != RETURN_SUCCESS) {
+      jspr_molecule_destroy(molecule);
+      return r;
+    }
+    // molecules past the size of the organism are checked, but not kept
+    if ((r = jspr_organism_add_molecule(organism, molecule)) != 0) {
+      jspr_molecule_destroy(molecule);
+      if (r == ERR_DUPLICATE_KEY)
+        return r;
+    }
+    molecule_start = needle + 1;
+    counter++;
+    needle = _find_first_char_between(
+      molecule_split,
+      molecule_start,
+      content_end
+    );
+  }
+  // still need to process the last one
+  jspr_molecule_t *molecule = jspr_molecule_initialize();
+  if ((r = _jspr_molecule_populate_generic(molecule, molecule_start, content_end, atom_split, strict)) != RETURN_SUCCESS) {
+    jspr_molecule_destroy(molecule);
+    return r;
+  }
+  // molecules past the size of the organism are checked, but not kept
+  if ((r = jspr_organism_add_molecule(organism, molecule)) != 0) {
+    jspr_molecule_destroy(molecule);
+    if (r == ERR_DUPLICATE_KEY)
+      return r;
+  }
+
+  #ifdef __DEBUG__
+  printf("Finish populating organism of size %d, added %d molecules.\n", organism->size, counter + 1);
+  #endif
+
+  return 0;
+}
+
+/**
+ * Scans at most max_bytes more bytes of the string, populating the molecules
+ * found along the way (same parameters as _jspr_organism_populate_generic)
+ *
+ * @param  parser    pointer to the parser structure
+ * @param  max_bytes number of bytes to scan during this step
+ * @return           RETURN_MORE_WORK if there is more work, RETURN_SUCCESS when done, or error code
+ *                   (calling it again after that returns the same value)
+ */
+_JSPR_SPECIALIZE int _jspr_parser_step_generic(jspr_parser_t *parser, int max_bytes, char molecule_split, char atom_split, int strict, int enclosed) {
+  jspr_organism_t *organism = parser->organism;
+  int r;
+  if (parser->status != RETURN_MORE_WORK)
+    return parser->status;
+  if (parser->molecule_start == NULL) {
+    parser->molecule_start = organism->ref_string + enclosed;
+    parser->scan = parser->molecule_start;
+    parser->content_end = organism->ref_string + organism->ref_string_len - enclosed;
+    if (parser->content_end < parser->molecule_start)
+      return parser->status = _display_error_and_return(ERR_INVAL, organism->ref_string, organism->ref_string_len);
+  }
+  // always move forward, even with an empty budget
+  if (max_bytes < 1)
+    max_bytes = 1;
+  char *budget_end = (parser->content_end - parser->scan > max_bytes)
+    ? parser->scan + max_bytes
+    : parser->content_end;
+
+  char *needle;
+  while ((needle = _find_first_char_between(molecule_split, parser->scan, budget_end)) != NULL) {
+    jspr_molecule_t *molecule = jspr_molecule_initialize();
+    if ((r = _jspr_molecule_populate_generic(molecule, parser->molecule_start, needle, atom_split, strict)) != RETURN_SUCCESS) {
+      jspr_molecule_destroy(molecule);
+      return parser->status = r;
+    }
+    if ((r = jspr_organism_add_molecule(organism, molecule)) != 0) {
+      jspr_molecule_destroy(molecule);
+      if (r == ERR_DUPLICATE_KEY)
+        return parser->status = r;
+    }
+    parser->molecule_start = needle + 1;
+    parser->scan = needle + 1;
+  }
+  if (budget_end != parser->content_end) {
+    parser->scan = budget_end;
+    return RETURN_MORE_WORK;
+  }
+
+  // still need to process the last one
+  jspr_molecule_t *molecule = jspr_molecule_initialize();
+  if ((r = _jspr_molecule_populate_generic(molecule, parser->molecule_start, parser->content_end, atom_split, strict)) != RETURN_SUCCESS) {
+    jspr_molecule_destroy(molecule);
+    return parser->status = r;
+  }
+  if ((r = jspr_organism_add_molecule(organism, molecule)) != 0) {
+    jspr_molecule_destroy(molecule);
+    if (r == ERR_DUPLICATE_KEY)
+      return parser->status = r;
+  }
+  return parser->status = RETURN_SUCCESS;
+}
+
+/**
+ * Dialect specific versions of jspr_size, jspr_organism_populate and jspr_parser_step,
+ * one set per dialect, to be used once per dialect in a single source file
+ */
+#define JSPR_DIALECT_DEFINE(name, molecule_split, atom_split, strict, enclosed) \
+  int jspr_##name##_size(char *string, int string_len) { \
+    return _jspr_size_generic(string, string_len, molecule_split, atom_split); \
+  } \
+  int jspr_##name##_organism_populate(jspr_organism_t *organism) { \
+    return _jspr_organism_populate_generic(organism, molecule_split, atom_split, strict, enclosed); \
+  } \
+  int jspr_##name##_parser_step(jspr_parser_t *parser, int max_bytes) { \
+    return _jspr_parser_step_generic(parser, max_bytes, molecule_split, atom_split, strict, enclosed); \
+  }
+
+#endif
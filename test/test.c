@@ -55,6 +55,9 @@ int test_life_cycle() {
   jspr_atom_t *atom = jspr_atom_initialize();
   jspr_atom_destroy(atom);
 
+  jspr_key_t *key = jspr_key_initialize();
+  jspr_key_destroy(key);
+
   return 0;
 }
 
@@ -180,6 +183,148 @@ int test_organism_populate() {
   return 0;
 }
 
+int test_organism_populate_parallel() {
+  char *ref_string_test = "{\"key1\":\"value1\",\"key2\":1234,\"key3\":true,\"key4\":\"value4\",\"key5\":5}";
+  char *ref_string_invalid_test = "{\"key1\":\"value1\",\"key2\":1234,\"key3\":true,\"key4\":\"value4,\"key5:5}";
+  int ref_string_test_len = strlen(ref_string_test);
+  char *duplicate_string_test = "{\"key1\":1,\"key2\":2,\"key1\":3,\"key4\":4,\"key5\":\"invalid}";
+  int ref_string_invalid_test_len = strlen(ref_string_invalid_test);
+  int duplicate_string_test_len = strlen(duplicate_string_test);
+  char *edge_string_tests[2] = {
+    ",\"a\":1,\"b\":2:x",
+    "{\"a\":1,\"b\":2:3,"
+  };
+  int threads;
+  int i;
+
+  for (threads = 1; threads <= 8; threads++) {
+    jspr_organism_t *serial = jspr_organism_initialize(5, ref_string_test, ref_string_test_len);
+    jspr_organism_t *parallel = jspr_organism_initialize(5, ref_string_test, ref_string_test_len);
+    jspr_organism_t *invalid = jspr_organism_initialize(5, ref_string_invalid_test, ref_string_invalid_test_len);
+
+    check(jspr_organism_populate(serial) == RETURN_SUCCESS);
+    check(jspr_organism_populate_parallel(parallel, threads) == RETURN_SUCCESS);
+    check(parallel->total == 5);
+    for (i = 0; i < 5; i++) {
+      check(
+        jspr_atom_eq_p(
+          parallel->molecules[i]->key,
+          serial->molecules[i]->key->start - 1,
+          serial->molecules[i]->key->end + 1,
+          ATOM_TYPE_STRING
+        ) && serial->molecules[i]->value->start == parallel->molecules[i]->value->start
+          && serial->molecules[i]->value->end == parallel->molecules[i]->value->end
+      );
+    }
+    check(jspr_organism_contains_key(parallel, "key5"));
+    check(jspr_organism_populate_parallel(invalid, threads) == ERR_INVAL);
+
+    // undersized organisms keep the first molecules, like jspr_organism_populate
+    jspr_organism_t *serial_undersized = jspr_organism_initialize(3, ref_string_test, ref_string_test_len);
+    jspr_organism_t *parallel_undersized = jspr_organism_initialize(3, ref_string_test, ref_string_test_len);
+    check(jspr_organism_populate(serial_undersized) == RETURN_SUCCESS);
+    check(jspr_organism_populate_parallel(parallel_undersized, threads) == RETURN_SUCCESS);
+    check(serial_undersized->total == 3 && parallel_undersized->total == 3);
+    check(jspr_organism_contains_key(parallel_undersized, "key3"));
+    check(!jspr_organism_contains_key(parallel_undersized, "key4"));
+
+    // the first error of the string wins, be it a duplicate or an invalid molecule
+    jspr_organism_t *serial_duplicate = jspr_organism_initialize(5, duplicate_string_test, duplicate_string_test_len);
+    jspr_organism_t *parallel_duplicate = jspr_organism_initialize(5, duplicate_string_test, duplicate_string_test_len);
+    jspr_organism_set_duplicate_policy(serial_duplicate, DUPLICATE_POLICY_REJECT);
+    jspr_organism_set_duplicate_policy(parallel_duplicate, DUPLICATE_POLICY_REJECT);
+    check(jspr_organism_populate(serial_duplicate) == ERR_DUPLICATE_KEY);
+    check(jspr_organism_populate_parallel(parallel_duplicate, threads) == ERR_DUPLICATE_KEY);
+    check(serial_duplicate->total == parallel_duplicate->total);
+    for (i = parallel_duplicate->total; i < 5; i++)
+      check(parallel_duplicate->molecules[i] == NULL);
+
+    // separators as first or last char are not separators for jspr_organism_populate
+    for (i = 0; i < 2; i++) {
+      char *edge_string_test = edge_string_tests[i];
+      int edge_string_test_len = strlen(edge_string_test);
+      int size = jspr_size(edge_string_test, edge_string_test_len);
+      jspr_organism_t *serial_edge = jspr_organism_initialize(size, edge_string_test, edge_string_test_len);
+      jspr_organism_t *parallel_edge = jspr_organism_initialize(size, edge_string_test, edge_string_test_len);
+      int serial_result = jspr_organism_populate(serial_edge);
+      check(jspr_organism_populate_parallel(parallel_edge, threads) == serial_result);
+      check(serial_edge->total == parallel_edge->total);
+      jspr_organism_destroy(serial_edge);
+      jspr_organism_destroy(parallel_edge);
+    }
+
+    jspr_organism_destroy(serial);
+    jspr_organism_destroy(parallel);
+    jspr_organism_destroy(invalid);
+    jspr_organism_destroy(serial_undersized);
+    jspr_organism_destroy(parallel_undersized);
+    jspr_organism_destroy(serial_duplicate);
+    jspr_organism_destroy(parallel_duplicate);
+  }
+
+  return 0;
+}
+
+int test_parser_step() {
+  char *ref_string_test = "{\"key1\":\"value1\",\"key2\":1234,\"key3\":true}";
+  char *ref_string_invalid_test = "{\"key1\":\"value1\",\"key2:1234,\"key3\":true}";
+  char *kv_string_test = "key1=12345;key2=\"value\"";
+  int ref_string_test_len = strlen(ref_string_test);
+  int ref_string_invalid_test_len = strlen(ref_string_invalid_test);
+  int kv_string_test_len = strlen(kv_string_test);
+  int max_bytes;
+  int steps;
+  int r;
+
+  for (max_bytes = 0; max_bytes <= ref_string_test_len; max_bytes++) {
+    jspr_organism_t *organism = jspr_organism_initialize(3, ref_string_test, ref_string_test_len);
+    jspr_parser_t *parser = jspr_parser_initialize(organism);
+    steps = 0;
+    while ((r = jspr_parser_step(parser, max_bytes)) == RETURN_MORE_WORK)
+      steps++;
+    check(r == RETURN_SUCCESS);
+    check(jspr_parser_step(parser, max_bytes) == RETURN_SUCCESS);
+    check(organism->total == 3);
+    check(
+      jspr_atom_eq_p(
+        organism->molecules[1]->key,
+        ref_string_test + 17,
+        ref_string_test + 23,
+        ATOM_TYPE_STRING
+      ) && jspr_atom_eq_p(
+        organism->molecules[2]->value,
+        ref_string_test + 36,
+        pointer_to_end_of_string(ref_string_test) - 1,
+        ATOM_TYPE_PRIMITIVE
+      )
+    );
+    // each step scans at most max_bytes (and at least one)
+    if (max_bytes > 0)
+      check(steps <= ref_string_test_len / max_bytes);
+    jspr_parser_destroy(parser);
+    jspr_organism_destroy(organism);
+  }
+
+  jspr_organism_t *invalid_organism = jspr_organism_initialize(3, ref_string_invalid_test, ref_string_invalid_test_len);
+  jspr_parser_t *invalid_parser = jspr_parser_initialize(invalid_organism);
+  while ((r = jspr_parser_step(invalid_parser, 4)) == RETURN_MORE_WORK);
+  check(r == ERR_INVAL);
+  check(jspr_parser_step(invalid_parser, 4) == ERR_INVAL);
+
+  jspr_organism_t *kv_organism = jspr_organism_initialize(2, kv_string_test, kv_string_test_len);
+  jspr_parser_t *kv_parser = jspr_parser_initialize(kv_organism);
+  while ((r = jspr_kv_parser_step(kv_parser, 4)) == RETURN_MORE_WORK);
+  check(r == RETURN_SUCCESS);
+  check(jspr_organism_contains_key(kv_organism, "key2"));
+
+  jspr_parser_destroy(invalid_parser);
+  jspr_organism_destroy(invalid_organism);
+  jspr_parser_destroy(kv_parser);
+  jspr_organism_destroy(kv_organism);
+
+  return 0;
+}
+
 int test_molecule_matches_string() {
   char *molecule_string = "\"match\":12345";
   char *match_test = "match";
@@ -243,6 +388,163 @@ int test_organism_find() {
   return 0;
 }
 
+int test_organism_find_n() {
+  char *organism_string = "{\"key1\":12345,\"key2\":\"value\",\"key3\":\"other value\"}";
+  int organism_string_len = strlen(organism_string);
+  // keys taken from another buffer, not NULL terminated
+  char *key_buffer = "key2key11";
+  jspr_organism_t *organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_atom_t *atom = jspr_atom_initialize();
+  jspr_key_t *key = jspr_key_initialize();
+  jspr_organism_populate(organism);
+
+  check(jspr_organism_find_n(atom, organism, key_buffer, 4));
+  check(jspr_atom_eq_p(atom, organism_string + 21, organism_string + 28, ATOM_TYPE_STRING));
+  check(jspr_organism_contains_key_n(organism, key_buffer + 4, 4));
+  check(!jspr_organism_find_n(atom, organism, key_buffer + 4, 5));
+  check(!jspr_organism_find_n(atom, organism, key_buffer, 3));
+
+  jspr_key_set(key, key_buffer, 4);
+  check(jspr_organism_find_key(atom, organism, key));
+  check(jspr_atom_eq_p(atom, organism_string + 21, organism_string + 28, ATOM_TYPE_STRING));
+  jspr_key_set(key, key_buffer + 4, 5);
+  check(!jspr_organism_find_key(atom, organism, key));
+
+  jspr_organism_destroy(organism);
+  jspr_atom_destroy(atom);
+  jspr_key_destroy(key);
+
+  return 0;
+}
+
+int test_organism_duplicate_policy() {
+  char *organism_string = "{\"key\":1,\"other\":2,\"key\":3}";
+  int organism_string_len = strlen(organism_string);
+  jspr_organism_t *first_organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_organism_t *second_organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_organism_t *third_organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_atom_t *atom = jspr_atom_initialize();
+
+  jspr_organism_set_duplicate_policy(second_organism, DUPLICATE_POLICY_LAST_WINS);
+  jspr_organism_set_duplicate_policy(third_organism, DUPLICATE_POLICY_REJECT);
+
+  check(jspr_organism_populate(first_organism) == RETURN_SUCCESS);
+  check(jspr_organism_find(atom, first_organism, "key"));
+  check(jspr_atom_eq_p(atom, organism_string + 7, organism_string + 8, ATOM_TYPE_PRIMITIVE));
+
+  check(jspr_organism_populate(second_organism) == RETURN_SUCCESS);
+  check(jspr_organism_find(atom, second_organism, "key"));
+  check(jspr_atom_eq_p(atom, organism_string + 25, organism_string + 26, ATOM_TYPE_PRIMITIVE));
+
+  check(jspr_organism_populate(third_organism) == ERR_DUPLICATE_KEY);
+
+  jspr_organism_destroy(first_organism);
+  jspr_organism_destroy(second_organism);
+  jspr_organism_destroy(third_organism);
+  jspr_atom_destroy(atom);
+
+  return 0;
+}
+
+int test_organism_find_all() {
+  char *organism_string = "{\"key\":1,\"other\":2,\"key\":3}";
+  int organism_string_len = strlen(organism_string);
+  jspr_organism_t *first_organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_organism_t *second_organism = jspr_organism_initialize(3, organism_string, organism_string_len);
+  jspr_atom_t *atoms[2] = {jspr_atom_initialize(), jspr_atom_initialize()};
+
+  jspr_organism_set_duplicate_policy(first_organism, DUPLICATE_POLICY_COLLECT_ALL);
+  jspr_organism_populate(first_organism);
+  jspr_organism_populate(second_organism);
+
+  check(jspr_organism_find_all(atoms, 2, first_organism, "key") == 2);
+  check(
+    jspr_atom_eq_p(atoms[0], organism_string + 7, organism_string + 8, ATOM_TYPE_PRIMITIVE)
+    && jspr_atom_eq_p(atoms[1], organism_string + 25, organism_string + 26, ATOM_TYPE_PRIMITIVE)
+  );
+  check(jspr_organism_find_all(atoms, 1, first_organism, "key") == 2);
+  check(jspr_organism_find_all(atoms, 2, first_organism, "missing") == 0);
+  check(jspr_organism_find_all(atoms, 2, second_organism, "key") == 1);
+
+  // length aware and prepared keys, from a buffer that is not NULL terminated
+  char *key_buffer = "keyother";
+  jspr_key_t *key = jspr_key_initialize();
+  jspr_key_set(key, key_buffer, 3);
+  check(jspr_organism_find_all_n(atoms, 2, first_organism, key_buffer, 3) == 2);
+  check(jspr_atom_eq_p(atoms[1], organism_string + 25, organism_string + 26, ATOM_TYPE_PRIMITIVE));
+  check(jspr_organism_find_all_key(atoms, 2, first_organism, key) == 2);
+  check(jspr_organism_find_all_n(atoms, 2, first_organism, key_buffer + 3, 5) == 1);
+  check(jspr_organism_find_all_n(atoms, 2, first_organism, key_buffer, 8) == 0);
+  jspr_key_destroy(key);
+
+  jspr_organism_destroy(first_organism);
+  jspr_organism_destroy(second_organism);
+  jspr_atom_destroy(atoms[0]);
+  jspr_atom_destroy(atoms[1]);
+
+  return 0;
+}
+
+int test_kv_dialect() {
+  char *kv_string_test = "key1=12345;key2=\"value\";key3=true";
+  char *kv_string_invalid_test = "key1=12345;key2=\"value;key3=true";
+  int kv_string_test_len = strlen(kv_string_test);
+  int kv_string_invalid_test_len = strlen(kv_string_invalid_test);
+  jspr_atom_t *atom = jspr_atom_initialize();
+
+  check(jspr_kv_size(kv_string_test, kv_string_test_len) == 3);
+  check(jspr_kv_size("key1=1,key2=2", 13) == -1);
+
+  jspr_organism_t *first_organism = jspr_organism_initialize(3, kv_string_test, kv_string_test_len);
+  jspr_organism_t *second_organism = jspr_organism_initialize(3, kv_string_invalid_test, kv_string_invalid_test_len);
+
+  check(jspr_kv_organism_populate(first_organism) == RETURN_SUCCESS);
+  check(
+    jspr_atom_eq_p(
+      first_organism->molecules[0]->key,
+      kv_string_test,
+      kv_string_test + 4,
+      ATOM_TYPE_PRIMITIVE
+    ) && jspr_atom_eq_p(
+      first_organism->molecules[2]->value,
+      kv_string_test + 29,
+      pointer_to_end_of_string(kv_string_test),
+      ATOM_TYPE_PRIMITIVE
+    )
+  );
+  check(jspr_organism_find(atom, first_organism, "key2"));
+  check(jspr_atom_eq_p(atom, kv_string_test + 16, kv_string_test + 23, ATOM_TYPE_STRING));
+
+  check(jspr_kv_organism_populate(second_organism) == ERR_INVAL);
+
+  jspr_organism_destroy(first_organism);
+  jspr_organism_destroy(second_organism);
+  jspr_atom_destroy(atom);
+
+  return 0;
+}
+
+// dialect defined outside of the library, as a user of jspr_dialect.h would
+JSPR_DIALECT_DEFINE(pipe, '|', ':', 1, 1)
+
+int test_user_dialect() {
+  char *pipe_string_test = "{\"key1\":\"a,b\"|\"key2\":12345}";
+  int pipe_string_test_len = strlen(pipe_string_test);
+  jspr_atom_t *atom = jspr_atom_initialize();
+  jspr_organism_t *organism = jspr_organism_initialize(2, pipe_string_test, pipe_string_test_len);
+
+  check(jspr_pipe_size(pipe_string_test, pipe_string_test_len) == 2);
+  check(jspr_pipe_organism_populate(organism) == RETURN_SUCCESS);
+  check(jspr_organism_find(atom, organism, "key1"));
+  check(jspr_atom_eq_p(atom, pipe_string_test + 8, pipe_string_test + 13, ATOM_TYPE_STRING));
+  check(jspr_organism_contains_key(organism, "key2"));
+
+  jspr_organism_destroy(organism);
+  jspr_atom_destroy(atom);
+
+  return 0;
+}
+
 int test_jspr_size() {
   char *first_valid_jspr_test = "{\"key1\":\"value\",\"key2\":12345,\"key3\":\"value\"}";
   char *second_valid_jspr_test = "{\"key\":12345}";
@@ -276,10 +578,21 @@ int main() {
   test(test_atom_populate, "atom populate");
   test(test_molecule_populate, "molecule populate");
   test(test_organism_populate, "organism populate");
+  #ifdef __JSPR_THREADS__
+  test(test_organism_populate_parallel, "organism populate in parallel");
+  #else
+  printf("TEST SKIPPED: organism populate in parallel (built without __JSPR_THREADS__)\n");
+  #endif
+  test(test_parser_step, "parse organism in steps");
   test(test_molecule_matches_string, "molecule matches string");
   test(test_organism_contains_key, "organism contains key");
   test(test_organism_find, "organism find value of key");
+  test(test_organism_find_n, "organism find value of length aware key");
+  test(test_organism_duplicate_policy, "organism duplicate key policy");
+  test(test_organism_find_all, "organism find all values of key");
   test(test_jspr_size, "determine jspr size of jspr string");
+  test(test_kv_dialect, "parse string of the kv dialect");
+  test(test_user_dialect, "parse string of a dialect defined outside of the library");
 
   printf("\n##############################\n"
          "##    Test session ended    ##\n"